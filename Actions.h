@@ -19,16 +19,33 @@ namespace Qui {
 
 
 // Widget Actions
-inline Action Disable(QWidget* widget) {
-   return boost::bind(&QWidget::setEnabled, widget, false);
+struct SetEnabled : public ActionExpr<SetEnabled> {
+   SetEnabled(QWidget* widget, bool enabled) 
+    : m_widget(widget), m_enabled(enabled) { }
+   void operator()() const { m_widget->setEnabled(m_enabled); }
+   QWidget* m_widget;
+   bool m_enabled;
+};
+
+struct SetSpinBoxValue : public ActionExpr<SetSpinBoxValue> {
+   SetSpinBoxValue(QSpinBox* widget, int value) 
+    : m_widget(widget), m_value(value) { }
+   void operator()() const { m_widget->setValue(m_value); }
+   QSpinBox* m_widget;
+   int m_value;
+};
+
+
+inline SetEnabled Disable(QWidget* widget) {
+   return SetEnabled(widget, false);
 }
 
-inline Action Enable(QWidget* widget) {
-   return boost::bind(&QWidget::setEnabled, widget, true);
+inline SetEnabled Enable(QWidget* widget) {
+   return SetEnabled(widget, true);
 }
 
-inline Action SetValue(QSpinBox* widget, int value ) {
-   return boost::bind(&QSpinBox::setValue, widget, value);
+inline SetSpinBoxValue SetValue(QSpinBox* widget, int value ) {
+   return SetSpinBoxValue(widget, value);
 }
 
 
@@ -5,12 +5,29 @@
  *  \class ExternalChargesSection 
  *
  *  \brief A KeywordSection class representing a $external_charges block
+ *
+ *  QM/MM calculations can embed the system in hundreds of thousands of point
+ *  charges, so the charges are held as an array of doubles (x, y, z, q for
+ *  each charge) rather than as text.  The array is implicitly shared, so
+ *  cloning the section does not copy the charges.  The preview only shows the
+ *  first few charges, and write() streams the full list when the input file
+ *  is saved, so the text of the whole list need never be held in memory.
+ *  Each list of charges is given an id which appears in the summary line of
+ *  a truncated preview.  If the preview text is read back in, the section is
+ *  marked as truncated and the InputDialog uses the id to find the section
+ *  holding the full list, which is then merged with the (possibly edited)
+ *  charges that were visible using restore().  Lines that cannot be read as a
+ *  charge are kept verbatim, along with their position in the list, and are
+ *  written back out in the same place.
  *   
  *  \author Andrew Gilbert
  *  \date February 2008
  */
 
 #include "KeywordSection.h"
+#include <QList>
+#include <QPair>
+#include <QVector>
 
 
 namespace Qui {
@@ -19,24 +36,49 @@ namespace Qui {
 class ExternalChargesSection : public KeywordSection {
    public:
       ExternalChargesSection(QString const& data = "", bool print = true) 
-       : KeywordSection("external_charges", print), m_data(data) {
-         processData();
+       : KeywordSection("external_charges", print), m_id(NextId()), 
+         m_truncated(false), m_sourceId(0), m_hidden(0) {
+         if (!data.isEmpty()) read(data);
       }
 
       ~ExternalChargesSection() {  }
 
       void read(QString const& input);
+      void write(QTextStream& stream);
       ExternalChargesSection* clone() const;
       QString previewFormat() const;
+      int nCharges() const { return m_charges.size() / 4; }
+      int id() const { return m_id; }
+      bool isTruncated() const { return m_truncated; }
+      int sourceId() const { return m_sourceId; }
+      bool restore(ExternalChargesSection const& source);
 
    protected:
       QString dump();
 
    private:
-      QString m_data;
-      QString m_truncatedData;
+      //! Sections with more charges than s_previewCharges are truncated in the
+      //! preview, showing only the first s_shownCharges.
+      static int const s_previewCharges = 10;
+      static int const s_shownCharges = 5;
+
+      QVector<double> m_charges;
+      int m_id;
+
+      //! Lines that could not be read, each with the number of charges that
+      //! preceded it.
+      typedef QList<QPair<int, QString> > InvalidLines;
+      InvalidLines m_invalid;
+
+      //! Set when the summary line of a truncated preview is read, along with
+      //! the id of the full list and the number of charges not shown.
+      bool m_truncated;
+      int m_sourceId;
+      int m_hidden;
 
-      void processData();
+      QString formatCharge(int const i) const;
+      void format(QTextStream& stream, int const nCharges) const;
+      static int NextId();
 };
 
 
@@ -5,20 +5,28 @@
  *  
  *  \brief A very simple window for displaying the contents of a file.
  *  
- *  Note that the target file is re-read and the display is updated
- *  intermittently as specified by the interval argument (in msec).  If the
- *  interval is set to 0 then no update is performed (acutally one is performed
- *  every INT_MAX msecs, which should be at least 24 days).
+ *  Note that the target file is watched for changes and the display is
+ *  updated at most once every interval msec when new output is written.  If
+ *  the interval is set to 0 then no update is performed.
+ *
+ *  Only a window of at most s_maxLines lines is held in the widget, so that
+ *  large output files can be followed for long periods.  The offset of every
+ *  s_stride'th line is recorded as the file grows, and older (or newer)
+ *  lines are read back in when the user scrolls to the top (or bottom) of
+ *  the window.  New output is only appended while the end of the file is in
+ *  the window.  Searches are limited to the lines in the window.
  *  
  *  \author Andrew Gilbert
  *  \date   March 2009
  */
 
 #include "ui_FileDisplay.h"
+#include <vector>
 
 class QFile;
 class QTimer;
 class QResizeEvent;
+class QFileSystemWatcher;
 
 namespace Qui {
 
@@ -48,6 +56,8 @@ class FileDisplay : public QMainWindow {
       void menuSmaller();
 
       void refresh();
+      void fileChanged();
+      void scrolled(int value);
       void findNext();
       void findPrevious();
       void caseSensitivityChanged(int state) { m_caseSensitive = state; }
@@ -57,13 +67,43 @@ class FileDisplay : public QMainWindow {
       Ui::FileDisplay m_ui;
       QFile*  m_file;
       QTimer* m_timer;
+      QFileSystemWatcher* m_watcher;
       FindDialog* m_findDialog;
       QString m_searchText;
       bool m_caseSensitive;
 
+      //! Offsets of lines 0, s_stride, 2*s_stride etc.
+      std::vector<qint64> m_checkpoints;
+      //! The offset just past the last complete line read
+      qint64 m_indexed;
+      //! The number of complete lines in the file
+      int m_nLines;
+      //! The complete lines [m_first, m_last) are displayed, followed by the
+      //! unterminated last line if m_tailShown is set.
+      int m_first;
+      int m_last;
+      bool m_tailShown;
+      bool m_paging;
+
+      static int const s_stride    = 64;
+      static int const s_maxLines  = 10000;
+      static int const s_pageLines = 2000;
+      static qint64 const s_chunkSize = 1 << 20;
+
       void openFile(QString const& fileName);
       void initializeMenus();
       void changeFont(QFont const& font);
+
+      void indexFile();
+      QString readLines(int const first, int const last);
+      QString readTail();
+      int displayedLines() const { return m_last - m_first + (m_tailShown ? 1:0); }
+      void insertLines(QString const& text, bool const atStart);
+      void removeLines(int const count, bool const fromStart);
+      void showTail();
+      void hideTail();
+      void pageUp();
+      void pageDown();
 };
 
 
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+#
+#  GenerateOptionSchema.py
+#
+#  Generates OptionSchema.h and OptionSchema.C from the options table in
+#  qchem_option.db.  The source file holds the option records as static data
+#  so that the QUI can start without opening the sqlite file, which is then
+#  only needed for the -dbedit mode, and the header declares them.  This
+#  script is run as part of the build, the generated files should not be
+#  edited or committed.
+#
+#  Usage:  python3 GenerateOptionSchema.py qchem_option.db OptionSchema.h \
+#             OptionSchema.C
+#
+
+import sys
+import sqlite3
+
+
+def literal(text):
+    """Returns text as a C string literal.  Non-ASCII characters are written
+    as UTF-8 octal escapes, which are always three digits wide so they cannot
+    run into a following digit."""
+    if text is None:
+        text = ""
+    if not isinstance(text, bytes):
+        text = text.encode("utf-8")
+    out = ['"']
+    for byte in bytearray(text):
+        ch = chr(byte)
+        if ch == '"':
+            out.append('\\"')
+        elif ch == '\\':
+            out.append('\\\\')
+        elif ch == '\n':
+            out.append('\\n')
+        elif ch == '\t':
+            out.append('\\t')
+        elif ch == '?':
+            # avoid trigraphs
+            out.append('\\?')
+        elif 32 <= byte < 127:
+            out.append(ch)
+        else:
+            out.append('\\%03o' % byte)
+    out.append('"')
+    return "".join(out)
+
+
+def split_options(options):
+    """Mirrors Option::optionArray(), i.e. split on ':' skipping empties."""
+    return [o for o in (options or "").split(":") if o]
+
+
+def replacements(name, options):
+    """Returns the (QUI value, QChem value) pairs for options of the form
+    text//replacement.  Malformed entries are skipped, as they are by
+    InputDialog::initializeControl()."""
+    pairs = []
+    for value in split_options(options):
+        split = value.split("//")
+        if len(split) == 2:
+            pairs.append((split[0], split[1]))
+        elif len(split) > 2:
+            sys.stderr.write("Warning: replacement for option %s is invalid: %s\n"
+                             % (name, value))
+    return pairs
+
+
+def write(fileName, lines):
+    handle = open(fileName, "w")
+    handle.write("\n".join(lines))
+    handle.close()
+
+
+def generate(database, header, source):
+    connection = sqlite3.connect(database)
+    rows = connection.execute(
+        "select Name, Type, \"Default\", Options, Description, Implementation "
+        "from options order by Name").fetchall()
+    connection.close()
+
+    banner = ("// Generated by GenerateOptionSchema.py from %s, do not edit."
+              % database.replace("\\", "/").split("/")[-1])
+
+    out = []
+    out.append(banner)
+    out.append("#ifndef QUI_OPTIONSCHEMA_H")
+    out.append("#define QUI_OPTIONSCHEMA_H")
+    out.append("")
+    out.append("namespace Qui {")
+    out.append("namespace OptionSchema {")
+    out.append("")
+    out.append("struct Entry {")
+    out.append("   char const* name;")
+    out.append("   int type;")
+    out.append("   int defaultIndex;")
+    out.append("   char const* options;")
+    out.append("   char const* description;")
+    out.append("   int implementation;")
+    out.append("};")
+    out.append("")
+    out.append("struct Replacement {")
+    out.append("   char const* option;")
+    out.append("   char const* quiValue;")
+    out.append("   char const* qchemValue;")
+    out.append("};")
+    out.append("")
+    out.append("extern Entry const entries[];")
+    out.append("extern unsigned int const entryCount;")
+    out.append("")
+    out.append("extern Replacement const replacements[];")
+    out.append("extern unsigned int const replacementCount;")
+    out.append("")
+    out.append("} // end namespace OptionSchema")
+    out.append("} // end namespace Qui")
+    out.append("")
+    out.append("#endif")
+    out.append("")
+    write(header, out)
+
+    out = []
+    out.append(banner)
+    out.append("#include \"OptionSchema.h\"")
+    out.append("")
+    out.append("namespace Qui {")
+    out.append("namespace OptionSchema {")
+    out.append("")
+    out.append("Entry const entries[] = {")
+    pairs = []
+    for name, option_type, default, options, description, impl in rows:
+        name = name.upper()
+        out.append("   { %s, %d, %d, %s,\n     %s,\n     %d }," % (
+            literal(name), option_type, default, literal(options),
+            literal(description), impl))
+        for qui, qchem in replacements(name, options):
+            pairs.append((name, qui, qchem))
+    if not rows:
+        out.append("   { 0, 0, 0, 0, 0, 0 }")
+    out.append("};")
+    out.append("")
+    out.append("unsigned int const entryCount = %d;" % len(rows))
+    out.append("")
+
+    out.append("Replacement const replacements[] = {")
+    for name, qui, qchem in pairs:
+        out.append("   { %s, %s, %s }," % (literal(name), literal(qui), literal(qchem)))
+    if not pairs:
+        out.append("   { 0, 0, 0 }")
+    out.append("};")
+    out.append("")
+    out.append("unsigned int const replacementCount = %d;" % len(pairs))
+    out.append("")
+    out.append("} // end namespace OptionSchema")
+    out.append("} // end namespace Qui")
+    out.append("")
+    write(source, out)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 4:
+        sys.stderr.write("Usage: %s qchem_option.db OptionSchema.h "
+                         "OptionSchema.C\n" % sys.argv[0])
+        sys.exit(1)
+    generate(sys.argv[1], sys.argv[2], sys.argv[3])
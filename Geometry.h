@@ -0,0 +1,74 @@
+#ifndef QUI_GEOMETRY_H
+#define QUI_GEOMETRY_H
+
+/*!
+ *  \class Geometry
+ *
+ *  \brief Holds a set of Cartesian coordinates.  The atoms are stored as a
+ *  structure of arrays, with the atomic numbers and the x, y and z components
+ *  held in separate vectors.  This avoids having to re-tokenize the text of
+ *  a $molecule section every time the atoms are needed, which matters for
+ *  QM/MM systems with tens of thousands of atoms.
+ *
+ *  \b Note:
+ *   - Atoms are given as an element symbol or atomic number followed by the
+ *     x, y and z coordinates.  Anything else, for example a Z-matrix or
+ *     ghost atom labels, cannot be read into a Geometry and should be kept
+ *     as text.
+ *   - Coordinates are only formatted as text when format() is called.
+ *   - Large sets of coordinates are split into chunks of lines which are
+ *     read in parallel, and the numbers are read with ScanDouble() rather
+ *     than by creating a QString for each one.
+ *
+ *  \date March 2009
+ */
+
+#include <vector>
+#include <QString>
+#include <QStringList>
+
+
+namespace Qui {
+
+class Geometry {
+
+   public:
+      Geometry() { }
+
+      bool read(QString const& coordinates, std::vector<int>* badLines = 0);
+      bool read(QChar const* begin, QChar const* end, 
+         std::vector<int>* badLines = 0);
+      QString format() const;
+
+      void clear();
+      void reserve(unsigned int const nAtoms);
+      void append(unsigned int const atomicNumber, double const x, 
+         double const y, double const z);
+      void append(Geometry const& that);
+
+      bool isEmpty() const { return m_atomicNumbers.empty(); }
+      unsigned int nAtoms() const { return m_atomicNumbers.size(); }
+
+      unsigned int atomicNumber(unsigned int const i) const { 
+         return m_atomicNumbers[i]; 
+      }
+      double x(unsigned int const i) const { return m_x[i]; }
+      double y(unsigned int const i) const { return m_y[i]; }
+      double z(unsigned int const i) const { return m_z[i]; }
+
+      int totalNuclearCharge() const;
+
+      static QString symbol(unsigned int const atomicNumber);
+      static unsigned int atomicNumber(QString const& symbol);
+
+
+   private:
+      std::vector<unsigned int> m_atomicNumbers;
+      std::vector<double> m_x;
+      std::vector<double> m_y;
+      std::vector<double> m_z;
+};
+
+
+} // end namespace Qui
+#endif
@@ -18,6 +18,7 @@
 #include "OptionRegister.h"
 #include <QFileInfo>
 #include <QFont>
+#include <QHash>
 #include <QProcess>
 #include <vector>
 
@@ -30,6 +31,8 @@ namespace Avogadro {
 
 
 class QResizeEvent;
+class QTextStream;
+class QTimer;
 
 
 namespace Qui {
@@ -114,6 +117,7 @@ class InputDialog : public QMainWindow
       void changeRadioButton(QString const& name, QString const& value);
 
       void updatePreviewText();
+      void schedulePreviewUpdate();
 
       // QProcess slots
       void jobStarted();
@@ -126,6 +130,7 @@ class InputDialog : public QMainWindow
 
       /********** Menu Slots **********/
       void menuOpen();
+      void menuOpenTrajectory();
       void menuSave()   { saveFile(false); }
       void menuSaveAs() { saveFile(true);  }
       void menuClose()  { close();  }
@@ -184,8 +189,29 @@ class InputDialog : public QMainWindow
       // activate them later on.
       std::map<QString, QAction*> m_menuActions;
 
-      // This contains the last preview text in case we want to undo
-      QString m_rememberMe;
+      // This contains the last preview text, one string per job, in case we
+      // want to undo
+      QStringList m_rememberMe;
+
+      //! The controls keyed on their upper case object names, which saves
+      //! searching the widget tree each time a control is needed.
+      QHash<QString, QWidget*> m_controls;
+
+      //! What is currently displayed in the preview for each job.  This is
+      //! used to only replace the text of the jobs that have changed.
+      struct PreviewJob {
+         PreviewJob(Job* job = 0, unsigned int revision = 0, int length = 0)
+          : job(job), revision(revision), length(length) { }
+         Job* job;
+         unsigned int revision;
+         int length;
+      };
+      std::vector<PreviewJob> m_previewJobs;
+      Job* m_previewCurrentJob;
+      int m_previewLength;
+
+      //! Coalesces the preview updates triggered by rapid control changes.
+      QTimer* m_previewTimer;
 
       Process::Monitor* m_processMonitor;
       std::vector<Process::Monitored*> m_processList;
@@ -201,6 +227,8 @@ class InputDialog : public QMainWindow
       void addJob(Job*);
 
       void finalizeJob();
+      QWidget* control(QString const& name);
+      void rebuildPreviewText(QStringList const& jobStrings);
       void setControls(Job* job);
       void resetControls();
 //      void initializeMenus();
@@ -227,8 +255,10 @@ class InputDialog : public QMainWindow
       void readCharges();
       void insertXYZ(QString const& coordinates);
 
+      void prepareInputDeck();
       QString generateInputDeck(bool preview);
       QStringList generateInputDeckJobs(bool preview);
+      void writeInputDeck(QTextStream& stream);
       void watchProcess(Process::Monitored* process);
 
       void fontAdjust(bool);
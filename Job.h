@@ -8,6 +8,12 @@
  *  required for a QChem run.  Note that there may be several Jobs contained in
  *  the one input file.  A Job must have a RemSection and a MoleculeSection,
  *  but all other sections are optional.
+ *
+ *  Each KeywordSection caches its own formatted text, and the Job caches the
+ *  text of the whole input.  revision() is the latest revision of any of the
+ *  sections, or of the Job itself when sections are added or removed, so it
+ *  changes whenever the text may have changed.  This allows the preview to
+ *  skip unchanged Jobs.
  *   
  *  \author Andrew Gilbert
  *  \date November 2008
@@ -16,15 +22,17 @@
 #include <map>
 #include <vector>
 #include <QString>
+#include "RemSection.h"
 
+class QTextStream;
 
-namespace Qui {
 
-typedef std::map<QString,QString> StringMap;
+namespace Qui {
 
-class RemSection;
 class KeywordSection;
 class MoleculeSection;
+class ExternalChargesSection;
+class Geometry;
 
 
 class Job {
@@ -35,7 +43,10 @@ class Job {
 
       Job(std::vector<KeywordSection*> sections);
 
-      Job(Job const& that) { copy(that); }
+      Job(Job const& that) : m_remSection(0), m_moleculeSection(0), 
+         m_externalCharges(0), m_revision(0) { 
+         copy(that); 
+      }
 
       Job const& operator=(Job const& that) {
          if (this != &that) copy (that);
@@ -43,6 +54,9 @@ class Job {
       }
       
       QString format(bool const preview);
+      void write(QTextStream& stream);
+      unsigned int revision() const;
+      void invalidate(QString const& name);
 
       void init();
       void addSection(KeywordSection* section);
@@ -51,16 +65,19 @@ class Job {
 	  // Pass-through functions.  These rely on the corresponding
 	  // KeywordSections to respond
       void printSection(QString const& name, bool doPrint);
-      void setOption(QString const& name, QString const& value);
-      void printOption(QString const& name, bool doPrint);
+      void setOption(Symbol const& name, QString const& value);
+      void printOption(Symbol const& name, bool doPrint);
       void setCharge(int);
       void setMultiplicity(int);
       void setCoordinates(QString const&);
+      void setGeometry(Geometry const&);
       QString  getCoordinates();
+      Geometry const* getGeometry();
       int getNumberOfAtoms();
+      bool readsCoordinates();
 
-      StringMap getOptions();
-      QString getOption(QString const& name);
+      OptionView getOptions();
+      QString getOption(Symbol const& name);
       QString getComment();
 
       KeywordSection* getSection(QString const& name);
@@ -69,18 +86,27 @@ class Job {
    private:
 	  //! We keep pointers to the RemSection and the Molecules section handy as
 	  //! we access them frequently and do not want to have to dynamically
-	  //! cast them all the time.
+	  //! cast them all the time.  The same goes for the external charges,
+	  //! which are formatted differently for the preview.
       RemSection* m_remSection;
       MoleculeSection* m_moleculeSection;
+      ExternalChargesSection* m_externalCharges;
 
 	  //! This contains a list of all the sections, including the RemSection
 	  //! and MoleculeSection
       std::map<QString,KeywordSection*> m_sections;
 
+      //! The cached text of the whole Job, with and without the preview
+      //! formatting, along with the revision it was generated at.
+      QString m_text[2];
+      unsigned int m_textRevision[2];
+      unsigned int m_revision;
+
 	  //! destroy is responsibe for deleting any resources that we own the
 	  //! pointers to
       void destroy();
       void copy(Job const& that);
+      std::vector<KeywordSection*> orderedSections();
 };
 
 } // end namespace Qui
@@ -0,0 +1,127 @@
+#ifndef QUI_JOURNAL_H
+#define QUI_JOURNAL_H
+
+/*!
+ *  \file Journal.h
+ *
+ *  \brief Classes used to keep the Queue across sessions of the QUI.
+ *
+ *  \date March 2009
+ */
+
+#include "Process.h"
+#include <QDateTime>
+#include <vector>
+
+
+namespace Qui {
+namespace Process {
+
+
+/*!
+ *  \class Journal
+ *
+ *  \brief An append-only record of the jobs passed through the Queue, which
+ *  allows the Queue and the Monitor to be rebuilt when the QUI is restarted,
+ *  including after a crash.
+ *
+ *  Each submit, start, finish and remove event is written as a single line of
+ *  tab separated fields as soon as it happens, and the file is closed after
+ *  each line so nothing is held in buffers.  A line left incomplete by a
+ *  crash is ignored when the journal is read back.  The journal is compacted
+ *  when it is replayed, keeping only the unfinished jobs and the most recently
+ *  finished ones.
+ *
+ *  Only one session may own the journal.  The owner holds an exclusive lock
+ *  on a separate lock file, see lock(), which the system releases if the
+ *  session crashes.  Other sessions may read() the journal but must not
+ *  replay() it or record anything in it.
+ */
+class Journal {
+
+   public:
+      //! Everything we know about a job, built up from its events
+      struct Record {
+         Record() : priority(0), pid(0), startTime(0), 
+            status(Status::Queued) { }
+         QString id;
+         int priority;
+         Resources resources;
+         QStringList dependencies;
+         QString input;
+         QString output;
+         QStringList arguments;
+         int pid;
+         //! See ProcessTree::StartTime(), 0 if not known
+         qint64 startTime;
+         QDateTime started;
+         QDateTime finished;
+         Status::ID status;
+         QString error;
+      };
+
+      Journal(QString const& fileName) : m_fileName(fileName), m_lock(-1) { }
+      ~Journal();
+
+      bool lock();
+
+      void submitted(Record const& record);
+      void started(QString const& id, int const pid);
+      void finished(QString const& id, Status::ID const status, 
+         QString const& error = QString());
+      void removed(QString const& id);
+
+      std::vector<Record> read() const;
+      std::vector<Record> replay();
+
+   private:
+      QString m_fileName;
+      //! The descriptor of the lock file, or -1 if we do not own the journal
+      int m_lock;
+
+      //! The number of finished jobs kept when the journal is compacted.
+      static unsigned int const s_maxFinished = 100;
+
+      void append(QStringList const& fields);
+      void compact(std::vector<Record> const& records);
+      static QString line(QStringList const& fields);
+};
+
+
+
+//! \class Reattached is a QChem job that was started by a previous session of
+//! the QUI.  We are not the parent of the process so we cannot wait on it,
+//! instead its pid is polled and finished() is emitted once it has gone, at
+//! which point the output file is checked for errors as usual.  The pid may
+//! have been reused, for example after a reboot, so the start time of the
+//! process must also match the one recorded in the journal.  Jobs that
+//! finished before the restart are also represented by this class so that
+//! they can be displayed in the Monitor.
+class Reattached : public QChem {
+
+   Q_OBJECT
+
+   public:
+      Reattached(QObject* parent, Journal::Record const& record);
+
+      void start() { }
+      void kill();
+      int  pid() { return m_pid; }
+
+   private Q_SLOTS:
+      void poll();
+
+   private:
+      int m_pid;
+      qint64 m_startTime;
+      QTimer* m_pollTimer;
+
+      bool alive() const;
+
+      static int const s_pollInterval = 5000;
+};
+
+
+} } // end namespaces Qui::Process
+
+#endif
@@ -6,6 +6,12 @@
  *
  *  \brief An abstract base class representing containers for holding $section
  *  data.  This base class primarily defines the I/O interface.
+ *
+ *  The output of dump() is cached by format() and only regenerated after the
+ *  section has been changed.  Derived classes must call invalidate() from
+ *  any function that changes what dump() would return.  Each change also
+ *  gives the section a new revision, which is drawn from a single increasing
+ *  counter so that revisions can be compared across sections.
  *   
  *  \author Andrew Gilbert
  *  \date January 2008
@@ -13,6 +19,8 @@
 
 #include <QString>
 
+class QTextStream;
+
 
 namespace Qui {
 
@@ -20,28 +28,58 @@ class KeywordSection {
 
    public:
       KeywordSection(QString const& name, bool print = true) 
-       : m_print(print), m_name(name) { }
+       : m_print(print), m_name(name), m_formatValid(false), 
+         m_revision(nextRevision()) { }
 
       virtual ~KeywordSection() { }
 
       QString name() const { return m_name; }
-      void print(bool print) { m_print = print; }
+      void print(bool print) { 
+         if (print != m_print) {
+            m_print = print; 
+            invalidate();
+         }
+      }
 
 	  //! This is just a wrapper for dump() which checks the m_print flag and
-	  //! is what should be called.
-      QString format();
+	  //! is what should be called.  The text is cached between changes.
+      QString const& format();
+
+      //! Writes the formatted text to the stream.  Sections that can be very
+      //! large override this to avoid building the text in memory.
+      virtual void write(QTextStream& stream);
+
+      //! Discards the cached text.  This only needs to be called from outside
+      //! the section if it has been changed indirectly, for example by
+      //! modifying the GeometryConstraints held by an OptSection.
+      void invalidate() { 
+         m_formatValid = false; 
+         m_revision = nextRevision();
+      }
+
+      unsigned int revision() const { return m_revision; }
+      static unsigned int nextRevision();
 
       virtual void read(QString const&) = 0;
       virtual KeywordSection* clone() const = 0;
 
+      //! Returns a description of any problem found by the last call to
+      //! read(), or an empty string if there were none.  Sections do not
+      //! report problems themselves as they may be read off the GUI thread.
+      QString const& error() const { return m_error; }
+
 
    protected:
       virtual QString dump() = 0;  
       bool m_print;
+      QString m_error;
 
 
    private:
       QString m_name;
+      QString m_formatted;
+      bool m_formatValid;
+      unsigned int m_revision;
       // This should prevent copying sections
       KeywordSection(KeywordSection const& that);
       KeywordSection const& operator=(KeywordSection const& that);
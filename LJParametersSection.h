@@ -11,6 +11,7 @@
  */
 
 #include "KeywordSection.h"
+#include "Geometry.h"
 #include <map>
 
 
@@ -26,6 +27,7 @@ class LJParametersSection : public KeywordSection {
       void read(QString const& input);
       LJParametersSection* clone() const;
       void generateData(QString const&);
+      void generateData(Geometry const&);
 
       static std::map<QString,QString> createMap();
 
@@ -35,6 +37,9 @@ class LJParametersSection : public KeywordSection {
    private:
       QString m_data;
       static std::map<QString,QString> s_parameters;
+
+      void appendParameters(int const index, QString const& symbol, bool& ok);
+      void warnMissingParameters();
 };
 
 
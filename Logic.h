@@ -2,7 +2,7 @@
 #define QUI_LOGIC_H
 
 /*!
- *  \file Logic.h 
+ *  \file Logic.h
  *
  *  \brief Defines the interface used in the Logic module.
  *
@@ -11,15 +11,27 @@
  *  not tested until the Rule is applied.  Conditions can change their state
  *  during their life time.
  *
- *  A \typedef Condition is any function that takes zero arguments and returns a
- *  boolean.  This means the state must be held internal to the function.
+ *  A Condition is any function object that takes zero arguments and returns
+ *  a boolean.  This means the state must be held internal to the function.
  *
- *  A \typedef Action is any function that takes zero arguments and returns
+ *  An Action is any function object that takes zero arguments and returns
  *  nothing.
  *
  *  A \typedef Rule is simply a Condition combined with up to two actions, one to
  *  take if the Condition is true and the other to take if it is false.
  *
+ *  Conditions and Actions are built up as expression templates, so compound
+ *  expressions such as
+ *
+ *  \code
+ *     If(node == "A" || node == "B", Enable(w1) + Enable(w2), Disable(w1))
+ *  \endcode
+ *
+ *  have a concrete type that the compiler can inline.  The only indirect
+ *  call is made when the Rule itself is run, as If() erases the type of the
+ *  whole branch when it is converted to a Rule.  The \typedef Condition and
+ *  \typedef Action function types can still be used for anything that needs
+ *  to be stored or passed around, and they mix freely with the expressions.
  *
  *  \author Andrew Gilbert
  *  \date   August 2008
@@ -27,64 +39,175 @@
 
 #include "boost/bind.hpp"
 #include "boost/function.hpp"
-#include "boost/tuple/tuple.hpp"
 
 
 namespace Qui {
 
 typedef boost::function<bool()> Condition;
 typedef boost::function<void()> Action;
-typedef boost::tuple<Condition, Action, Action> Rule;
+typedef boost::function<void()> Rule;
 
 
 inline void DoNothing() { }
 
+
+//! Base classes that mark the expression types.  These only exist so that the
+//! operators below are restricted to Conditions and Actions.
+template <class Derived>
+struct ConditionExpr {
+   Derived const& derived() const { return static_cast<Derived const&>(*this); }
+};
+
+template <class Derived>
+struct ActionExpr {
+   Derived const& derived() const { return static_cast<Derived const&>(*this); }
+};
+
+
+//! Plain functions can be used as Conditions and Actions, but they need to be
+//! stored as pointers.
+template <class F>
+struct Stored { typedef F Type; };
+
+template <class R>
+struct Stored<R()> { typedef R (*Type)(); };
+
+
+
+// Condition expressions
+template <class A>
+struct Not : public ConditionExpr<Not<A> > {
+   Not(A const& a) : m_a(a) { }
+   bool operator()() const { return !m_a(); }
+   A m_a;
+};
+
+template <class A, class B>
+struct And : public ConditionExpr<And<A, B> > {
+   And(A const& a, B const& b) : m_a(a), m_b(b) { }
+   bool operator()() const { return m_a() && m_b(); }
+   A m_a;
+   B m_b;
+};
+
+template <class A, class B>
+struct Or : public ConditionExpr<Or<A, B> > {
+   Or(A const& a, B const& b) : m_a(a), m_b(b) { }
+   bool operator()() const { return m_a() || m_b(); }
+   A m_a;
+   B m_b;
+};
+
+
+// Action expressions
+struct Nothing : public ActionExpr<Nothing> {
+   void operator()() const { }
+};
+
+template <class A, class B>
+struct Seq : public ActionExpr<Seq<A, B> > {
+   Seq(A const& a, B const& b) : m_a(a), m_b(b) { }
+   void operator()() const { m_a(); m_b(); }
+   A m_a;
+   B m_b;
+};
+
+
+//! The compiled form of a Rule.  This is what gets type-erased when it is
+//! stored as a Rule.
+template <class C, class T, class F>
+struct Branch {
+   Branch(C const& cond, T const& trueAction, F const& falseAction)
+    : m_cond(cond), m_true(trueAction), m_false(falseAction) { }
+
+   void operator()() const {
+      if (m_cond()) {
+         m_true();
+      }else {
+         m_false();
+      }
+   }
+
+   C m_cond;
+   T m_true;
+   F m_false;
+};
+
+
+
 //! Convenience function used to create a new Rule from an existing Condition
 //! and Action(s)
-inline Rule If(Condition const& condition, Action const& trueAction, 
-   Action const& falseAction = DoNothing) {
-   return boost::make_tuple(condition, trueAction, falseAction);
+template <class C, class T, class F>
+inline Branch<typename Stored<C>::Type, typename Stored<T>::Type,
+   typename Stored<F>::Type>
+If(C const& condition, T const& trueAction, F const& falseAction) {
+   return Branch<typename Stored<C>::Type, typename Stored<T>::Type,
+      typename Stored<F>::Type>(condition, trueAction, falseAction);
 }
 
+template <class C, class T>
+inline Branch<typename Stored<C>::Type, typename Stored<T>::Type, Nothing>
+If(C const& condition, T const& trueAction) {
+   return Branch<typename Stored<C>::Type, typename Stored<T>::Type, Nothing>(
+      condition, trueAction, Nothing());
+}
 
 
-//! The following are really only requred for binding in the operators below.
-inline bool Not(Condition const& cond) { 
-   return !cond(); 
-}
 
-inline bool  Or(Condition const& cond1, Condition const& cond2) { 
-   return cond1() || cond2(); 
+//! The following operators can be used to combine Conditions in an intuitive
+//! manner.  Note that they return new Conditions and not boolean values.
+template <class A>
+inline Not<A> operator!(ConditionExpr<A> const& cond) {
+   return Not<A>(cond.derived());
 }
 
-inline bool And(Condition const& cond1, Condition const& cond2) { 
-   return cond1() && cond2(); 
+template <class A, class B>
+inline Or<A, B> operator||(ConditionExpr<A> const& cond1,
+   ConditionExpr<B> const& cond2) {
+   return Or<A, B>(cond1.derived(), cond2.derived());
 }
 
-inline void Plus(Action const& act1, Action const& act2) { 
-   act1(); act2(); 
+template <class A, class B>
+inline And<A, B> operator&&(ConditionExpr<A> const& cond1,
+   ConditionExpr<B> const& cond2) {
+   return And<A, B>(cond1.derived(), cond2.derived());
 }
 
+template <class A, class B>
+inline Seq<A, B> operator+(ActionExpr<A> const& act1,
+   ActionExpr<B> const& act2) {
+   return Seq<A, B>(act1.derived(), act2.derived());
+}
 
 
+// Versions for the type-erased Conditions and Actions, including mixtures with
+// the expression types.
+inline Not<Condition> operator!(Condition const& cond) {
+   return Not<Condition>(cond);
+}
 
+inline Or<Condition, Condition> operator||(Condition const& cond1,
+   Condition const& cond2) {
+   return Or<Condition, Condition>(cond1, cond2);
+}
 
-//! The following operators can be used to combine Conditions in an intuitive
-//! manner.  Note that they return new Conditions and not boolean values.
-inline Condition const operator!(Condition const& cond) {
-   return boost::bind(&Not, cond);
-} 
+inline And<Condition, Condition> operator&&(Condition const& cond1,
+   Condition const& cond2) {
+   return And<Condition, Condition>(cond1, cond2);
+}
 
-inline Condition const operator||(Condition const& cond1, Condition const& cond2) {
-   return boost::bind(&Or, cond1, cond2);
-} 
+inline Seq<Action, Action> operator+(Action const& act1, Action const& act2) {
+   return Seq<Action, Action>(act1, act2);
+}
 
-inline Condition const operator&&(Condition const& cond1, Condition const& cond2) {
-   return boost::bind(&And, cond1, cond2);
+template <class A>
+inline Seq<A, Action> operator+(ActionExpr<A> const& act1, Action const& act2) {
+   return Seq<A, Action>(act1.derived(), act2);
 }
 
-inline Action const operator+(Action const& act1, Action const& act2) { 
-   return boost::bind(&Plus, act1, act2);
+template <class B>
+inline Seq<Action, B> operator+(Action const& act1, ActionExpr<B> const& act2) {
+   return Seq<Action, B>(act1, act2.derived());
 }
 
 
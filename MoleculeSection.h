@@ -4,13 +4,19 @@
 /*!
  *  \class MoleculeSection
  *
- *  \brief A KeywordSection class representing a $molecule section.
+ *  \brief A KeywordSection class representing a $molecule section.  Cartesian
+ *  coordinates are parsed into a Geometry, but the text they were read from
+ *  is kept and written back unchanged, so precision, atom labels and layout
+ *  are preserved.  The Geometry is only formatted once it has been replaced
+ *  with setGeometry().  Anything else, such as a Z-matrix or "read", is only
+ *  kept as text.
  *   
  *  \author Andrew Gilbert
  *  \date January 2008
  */
 
 #include "KeywordSection.h"
+#include "Geometry.h"
 
 
 namespace Qui {
@@ -26,12 +32,25 @@ class MoleculeSection : public KeywordSection {
       void read(QString const& input);
       MoleculeSection* clone() const;
 
-      void setCharge(int charge) { m_charge = charge; }
-      void setMultiplicity(int multiplicity) { m_multiplicity = multiplicity; }
+      void setCharge(int charge) { 
+         if (charge != m_charge) {
+            m_charge = charge; 
+            invalidate();
+         }
+      }
+      void setMultiplicity(int multiplicity) { 
+         if (multiplicity != m_multiplicity) {
+            m_multiplicity = multiplicity; 
+            invalidate();
+         }
+      }
       void setCoordinates(QString const& coordinates);
+      void setGeometry(Geometry const& geometry);
 
-      QString getCoordinates() { return m_coordinates; }
+      QString getCoordinates();
+      Geometry const& getGeometry() const { return m_geometry; }
       int getNumberOfAtoms() { return m_numberOfAtoms; }
+      bool isRead() const { return m_coordinates == "read"; }
 
 
    protected:
@@ -42,7 +61,10 @@ class MoleculeSection : public KeywordSection {
       int m_charge;
       int m_multiplicity;
       int m_numberOfAtoms;
+      //! The text the coordinates were read from, empty if the Geometry was
+      //! set directly
       QString m_coordinates;
+      Geometry m_geometry;
 
       void parseCoordinates();
 };
@@ -26,31 +26,230 @@
  *  Then B is automatically updated to the value of 40.  Actually the If
  *  memeber function is more general than this and will accept any Condition
  *  and any Action (see typedefs below).
+ *
+ *  Several changes can be batched together using a transaction:
+ *
+ *  \code
+ *     {
+ *        NodeBase::Transaction transaction;
+ *        A.setValue(20);
+ *        C.setValue(30);
+ *     }
+ *  \endcode
+ *
+ *  in which case the rules of A and C, and of any nodes they change, are
+ *  run once the transaction goes out of scope.
  *  
  *  \author Andrew Gilbert
  *  \date   July 2008
  */
 
-#include <map>
+#include <vector>
+#include <algorithm>
+#include <QSet>
+#include <QString>
+#include <QtDebug>
 #include "Logic.h"
 
 
 namespace Qui {
 
 template <class T> class Node;
+template <class T> struct NodeAssign;
+template <class T> struct NodeCopy;
 
 class NodeBase {
    public: 
+      NodeBase() : m_version(0), m_rulesPending(false), m_signalPending(false), 
+         m_rank(0), m_runs(0) { }
+
+      virtual ~NodeBase() { cancel(); }
+
       template <class T>
       T getValue() { 
          Node<T>* n = dynamic_cast<Node<T>*>(this);
          return n ? n->getValue() : T();
       }
+
+      //! Returns the total number of rule Conditions evaluated by all Nodes.
+      //! Sampling this before and after a setValue() gives the cost of the
+      //! update.
+      static unsigned long evaluations() { return evaluationCount(); }
+      static void resetEvaluations() { evaluationCount() = 0; }
+
+      //! This is incremented every time the value of the node changes, and
+      //! allows values derived from the node to be cached.
+      unsigned long version() const { return m_version; }
+
+      //! Changes to Node values made between beginTransaction() and the
+      //! matching commitTransaction() are applied as a batch.  The values
+      //! change immediately, but the rules are only run at commit, in
+      //! dependency order, and each Node emits its signals at most once after
+      //! all the rules have been run.  Transactions may be nested, in which
+      //! case only the outermost commit has any effect.  Outside a transaction
+      //! each setValue() is treated as a transaction of its own.
+      static void beginTransaction() { ++propagation().depth; }
+      static void commitTransaction();
+
+      //! Convenience class which holds a transaction open for its lifetime.
+      class Transaction {
+         public:
+            Transaction() { NodeBase::beginTransaction(); }
+            ~Transaction() { NodeBase::commitTransaction(); }
+         private:
+            Transaction(Transaction const&);
+            Transaction const& operator=(Transaction const&);
+      };
+
+
+   protected:
+      static unsigned long& evaluationCount() {
+         static unsigned long count(0);
+         return count;
+      }
+
+      void valueChanged();
+      virtual void applyRules() = 0;
+      virtual void emitSignals() { }
+      virtual QString description() const { return QString(); }
+
+
+   private:
+      struct Propagation {
+         Propagation() : depth(0), current(0) { }
+         int depth;
+         NodeBase* current;                // node whose rules are running
+         std::vector<NodeBase*> pending;   // nodes whose rules need running
+         std::vector<NodeBase*> changed;   // nodes with signals to emit
+      };
+
+      static Propagation& propagation() {
+         static Propagation p;
+         return p;
+      }
+
+      //! A node whose rules are run this many times in the one transaction is
+      //! assumed to be part of a cycle.
+      static unsigned int const s_maxRuns = 32;
+
+      static void propagate();
+      void cancel();
+
+      unsigned long m_version;
+      bool m_rulesPending;
+      bool m_signalPending;
+      unsigned int m_rank;   // learnt position in the dependency order
+      unsigned int m_runs;
 };
 
 
 
 
+//! Schedules the rules and signals for a node whose value has changed.  If
+//! the change was made by the rules of another node, the edge is recorded by
+//! ranking this node after that one.
+inline void NodeBase::valueChanged() {
+   Propagation& p(propagation());
+   ++m_version;
+
+   if (p.current && p.current != this && m_rank <= p.current->m_rank) {
+      m_rank = p.current->m_rank + 1;
+   }
+   if (!m_rulesPending) {
+      m_rulesPending = true;
+      p.pending.push_back(this);
+   }
+   if (!m_signalPending) {
+      m_signalPending = true;
+      p.changed.push_back(this);
+   }
+}
+
+
+
+//! Runs the pending rules, lowest rank first, until no more nodes change.
+//! Rules that change other nodes add them to the pending list.
+inline void NodeBase::propagate() {
+   Propagation& p(propagation());
+
+   while (!p.pending.empty()) {
+      unsigned int next(0);
+      for (unsigned int i = 1; i < p.pending.size(); ++i) {
+          if (p.pending[i]->m_rank < p.pending[next]->m_rank) next = i;
+      }
+
+      NodeBase* node(p.pending[next]);
+      p.pending.erase(p.pending.begin() + next);
+      node->m_rulesPending = false;
+
+      if (++node->m_runs > s_maxRuns) {
+         qDebug() << "ERROR: Cycle detected in the node logic involving" 
+                  << node->description() << ", abandoning rule propagation";
+         for (unsigned int i = 0; i < p.pending.size(); ++i) {
+             p.pending[i]->m_rulesPending = false;
+         }
+         p.pending.clear();
+         break;
+      }
+
+      p.current = node;
+      node->applyRules();
+      p.current = 0;
+   }
+
+   p.current = 0;
+}
+
+
+
+inline void NodeBase::commitTransaction() {
+   Propagation& p(propagation());
+
+   if (p.depth <= 0) {
+      qDebug() << "ERROR: NodeBase::commitTransaction() called without begin";
+      return;
+   }
+   if (p.depth > 1) {
+      --p.depth;
+      return;
+   }
+
+   // Still within the transaction, so changes made by rules are scheduled
+   // rather than applied recursively.
+   propagate();
+   --p.depth;
+
+   // Signals may trigger further changes, these start their own transaction.
+   std::vector<NodeBase*> changed;
+   changed.swap(p.changed);
+   for (unsigned int i = 0; i < changed.size(); ++i) {
+       changed[i]->m_runs = 0;
+       changed[i]->m_signalPending = false;
+   }
+   for (unsigned int i = 0; i < changed.size(); ++i) {
+       changed[i]->emitSignals();
+   }
+}
+
+
+
+//! Removes any references to this node from the propagation lists.
+inline void NodeBase::cancel() {
+   Propagation& p(propagation());
+   if (p.current == this) p.current = 0;
+   if (m_rulesPending) {
+      p.pending.erase(std::remove(p.pending.begin(), p.pending.end(), this), 
+         p.pending.end());
+   }
+   if (m_signalPending) {
+      p.changed.erase(std::remove(p.changed.begin(), p.changed.end(), this), 
+         p.changed.end());
+   }
+}
+
+
+
+
 template <class T> 
 class Node : public NodeBase {
 
@@ -61,64 +260,47 @@ class Node : public NodeBase {
 
       T getValue() const { return m_value; }
 
-      Action shouldBe(T value) { 
-         return boost::bind(&Node<T>::setValue, this, value); 
+      NodeAssign<T> shouldBe(T value) { 
+         return NodeAssign<T>(this, value); 
       }
 
-      // This does not appear to be working at the moment
-      Action makeSameAs(Node<T>* node) { 
-         return boost::bind(&Node<T>::setValue2, this, node); 
+      NodeCopy<T> makeSameAs(Node<T>* node) { 
+         return NodeCopy<T>(this, node); 
       }
 
       virtual void setValue(T const& value) {
          if (value != m_value) {
+            Transaction transaction;
             m_value = value;
-            applyRules();
-            emitSignals();
+            valueChanged();
          }
       }
 
 
+      //! Rules are stored by value in the order they are added.  Each Rule
+      //! is a compiled branch holding its Condition together with both
+      //! Actions, so the Condition is only evaluated once when the rules are
+      //! applied and there is only the one indirect call per Rule.
       void addRule(Rule const& rule) {
-         m_rules.insert(
-            std::make_pair( 
-               new Condition(rule.get<0>()),
-               new Action(rule.get<1>()) ));
-
-         m_rules.insert(
-            std::make_pair( 
-               new Condition(!rule.get<0>()), 
-               new Action(rule.get<2>()) ));
+         m_rules.push_back(rule);
       }
 
 
    //protected:
       // This is protected as a Register should be used for destruction
-      virtual ~Node() {
-         std::multimap<Condition*, Action*>::iterator iter;      
-         for (iter = m_rules.begin(); iter != m_rules.end(); ++iter) {
-             delete iter->first;
-             delete iter->second;
-         }
-         m_rules.clear(); 
-      }
+      virtual ~Node() { }
 
 
    private:
       T m_value;
-      // These must be pointers due to an STL requirement
-      std::multimap<Condition*, Action*> m_rules;
-
-      void setValue2(Node<T>* node) {
-         setValue(node->getValue());
-      }
+      std::vector<Rule> m_rules;
 
+      // Note that an Action may add rules to this node, so we index rather
+      // than iterate.
       void applyRules() {
-         std::multimap<Condition*, Action*>::iterator iter;
-         for (iter = m_rules.begin(); iter != m_rules.end(); ++iter) {
-             if((iter->first )->operator()() ) {
-                (iter->second)->operator()();
-             }
+         for (unsigned int i = 0; i < m_rules.size(); ++i) {
+             ++evaluationCount();
+             m_rules[i]();
          }
       }
 
@@ -167,93 +349,194 @@ inline bool Equals2(Node<QString> const* node1, Node<QString> const* node2) {
 
 
 
+// Node Logic expressions.  These are the Conditions and Actions returned by
+// the operators below and the Node member functions.
+template <class T>
+struct NodeEquals : public ConditionExpr<NodeEquals<T> > {
+   NodeEquals(Node<T> const* node, T const& value) 
+    : m_node(node), m_value(value) { }
+   bool operator()() const { return Equals(m_node, m_value); }
+   Node<T> const* m_node;
+   T m_value;
+};
+
+template <class T>
+struct NodeEquals2 : public ConditionExpr<NodeEquals2<T> > {
+   NodeEquals2(Node<T> const* node1, Node<T> const* node2) 
+    : m_node1(node1), m_node2(node2) { }
+   bool operator()() const { return Equals2(m_node1, m_node2); }
+   Node<T> const* m_node1;
+   Node<T> const* m_node2;
+};
+
+template <class T>
+struct NodeLess : public ConditionExpr<NodeLess<T> > {
+   NodeLess(Node<T> const* node, T const& value) 
+    : m_node(node), m_value(value) { }
+   bool operator()() const { return LessThan(m_node, m_value); }
+   Node<T> const* m_node;
+   T m_value;
+};
+
+template <class T>
+struct NodeLess2 : public ConditionExpr<NodeLess2<T> > {
+   NodeLess2(Node<T> const* node1, Node<T> const* node2) 
+    : m_node1(node1), m_node2(node2) { }
+   bool operator()() const { return LessThan2(m_node1, m_node2); }
+   Node<T> const* m_node1;
+   Node<T> const* m_node2;
+};
+
+//! A memoized test of whether the value of a string Node is one of a given
+//! set of values.  The comparison is case insensitive and is made against a
+//! hashed set, and the result is only recomputed when the Node changes.
+class IsOneOf : public ConditionExpr<IsOneOf> {
+   public:
+      IsOneOf(Node<QString> const* node, char const* const* values, 
+         unsigned int const count) : m_node(node), m_version(0), 
+         m_value(false) {
+         for (unsigned int i = 0; i < count; ++i) {
+             m_values.insert(QString(values[i]).toUpper());
+         }
+         update();
+      }
+
+      bool operator()() const {
+         if (m_version != m_node->version()) update();
+         return m_value;
+      }
+
+   private:
+      Node<QString> const* m_node;
+      QSet<QString> m_values;
+      mutable unsigned long m_version;
+      mutable bool m_value;
+
+      void update() const {
+         m_version = m_node->version();
+         m_value = m_values.contains(m_node->getValue().toUpper());
+      }
+};
+
+
+template <class T>
+struct NodeAssign : public ActionExpr<NodeAssign<T> > {
+   NodeAssign(Node<T>* node, T const& value) : m_node(node), m_value(value) { }
+   void operator()() const { m_node->setValue(m_value); }
+   Node<T>* m_node;
+   T m_value;
+};
+
+template <class T>
+struct NodeCopy : public ActionExpr<NodeCopy<T> > {
+   NodeCopy(Node<T>* node, Node<T> const* source) 
+    : m_node(node), m_source(source) { }
+   void operator()() const { m_node->setValue(m_source->getValue()); }
+   Node<T>* m_node;
+   Node<T> const* m_source;
+};
+
+
+
+
 // Node Logic Operators.  These are all overloaded to return Conditions rather
 // than bools
 template <class T>
-inline Condition const operator==(T const& value, Node<T> const& node) {
-   return boost::bind(&Equals<T>, &node, value);
+inline NodeEquals<T> const operator==(T const& value, Node<T> const& node) {
+   return NodeEquals<T>(&node, value);
 }
 template <class T>
-inline Condition const operator==(Node<T> const& node, T const& value) {
-   return boost::bind(&Equals<T>, &node, value);
+inline NodeEquals<T> const operator==(Node<T> const& node, T const& value) {
+   return NodeEquals<T>(&node, value);
 } 
 template <class T>
-inline Condition const operator==(Node<T> const& node1, Node<T> const& node2) {
-   return boost::bind(&Equals2<T>, &node1, &node2);
+inline NodeEquals2<T> const operator==(Node<T> const& node1, 
+   Node<T> const& node2) {
+   return NodeEquals2<T>(&node1, &node2);
 } 
 
 
 // <
 template <class T>
-inline Condition const operator<(T const& value, Node<T> const& node) {
-   return boost::bind(&LessThan<T>, &node, value);
+inline NodeLess<T> const operator<(T const& value, Node<T> const& node) {
+   return NodeLess<T>(&node, value);
 } 
 template <class T>
-inline Condition const operator<(Node<T> const& node, T const& value) {
-   return boost::bind(&LessThan<T>, &node, value);
+inline NodeLess<T> const operator<(Node<T> const& node, T const& value) {
+   return NodeLess<T>(&node, value);
 } 
 template <class T>
-inline Condition const operator<(Node<T> const& node1, Node<T> const& node2) {
-   return boost::bind(&LessThan2<T>, &node1, &node2);
+inline NodeLess2<T> const operator<(Node<T> const& node1, Node<T> const& node2) {
+   return NodeLess2<T>(&node1, &node2);
 } 
 
 
 // !=
 template <class T>
-inline Condition const operator!=(T const& value, Node<T> const& node) {
+inline Not<NodeEquals<T> > const operator!=(T const& value, 
+   Node<T> const& node) {
    return !(node == value);
 } 
 template <class T>
-inline Condition const operator!=(Node<T> const& node, T const& value) {
+inline Not<NodeEquals<T> > const operator!=(Node<T> const& node, 
+   T const& value) {
    return !(node == value);
 } 
 template <class T>
-inline Condition const operator!=(Node<T> const& node1, Node<T> const& node2) {
+inline Not<NodeEquals2<T> > const operator!=(Node<T> const& node1, 
+   Node<T> const& node2) {
    return !(node1 == node2);
 } 
 
 
 // >
 template <class T>
-inline Condition const operator>(T const& value, Node<T> const& node) {
+inline And<Not<NodeEquals<T> >, Not<NodeLess<T> > > const operator>(
+   T const& value, Node<T> const& node) {
    return !(node == value) && !(node < value);
 } 
 template <class T>
-inline Condition const operator>(Node<T> const& node, T const& value) {
+inline And<Not<NodeEquals<T> >, Not<NodeLess<T> > > const operator>(
+   Node<T> const& node, T const& value) {
    return !(node == value) && !(node < value);
 } 
 template <class T>
-inline Condition const operator>(Node<T> const& node1, Node<T> const& node2) {
+inline And<Not<NodeEquals2<T> >, Not<NodeLess2<T> > > const operator>(
+   Node<T> const& node1, Node<T> const& node2) {
    return !(node1 == node2) && !(node1 < node2);
 } 
 
 
 // <=
 template <class T>
-inline Condition const operator<=(T const& value, Node<T> const& node) {
+inline Not<And<Not<NodeEquals<T> >, Not<NodeLess<T> > > > const operator<=(
+   T const& value, Node<T> const& node) {
    return !(node > value);
 } 
 template <class T>
-inline Condition const operator<=(Node<T> const& node, T const& value) {
+inline Not<And<Not<NodeEquals<T> >, Not<NodeLess<T> > > > const operator<=(
+   Node<T> const& node, T const& value) {
    return !(node > value);
 } 
 template <class T>
-inline Condition const operator<=(Node<T> const& node1, Node<T> const& node2) {
+inline Not<And<Not<NodeEquals2<T> >, Not<NodeLess2<T> > > > const operator<=(
+   Node<T> const& node1, Node<T> const& node2) {
    return !(node1 > node2);
 } 
 
 
 // >=
 template <class T>
-inline Condition const operator>=(T const& value, Node<T> const& node) {
+inline Not<NodeLess<T> > const operator>=(T const& value, Node<T> const& node) {
    return !(node < value);
 } 
 template <class T>
-inline Condition const operator>=(Node<T> const& node, T const& value) {
+inline Not<NodeLess<T> > const operator>=(Node<T> const& node, T const& value) {
    return !(node < value);
 } 
 template <class T>
-inline Condition const operator>=(Node<T> const& node1, Node<T> const& node2) {
+inline Not<NodeLess2<T> > const operator>=(Node<T> const& node1, 
+   Node<T> const& node2) {
    return !(node1 < node2);
 } 
 
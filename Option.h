@@ -8,11 +8,17 @@
  *  program option.  The idea is that Options are smart configuration options
  *  that know what type they are (integer, string, etc.) the default value,
  *  valid options and embedded documentation. 
+ *
+ *  The value list, replacements and numeric limits are parsed once when the
+ *  options are set, so the accessors do no string processing.  All the list
+ *  members are implicitly shared, so copying an Option is cheap.
  *   
  *  \author Andrew Gilbert
  *  \date August 2008
  */
 
+#include <QList>
+#include <QPair>
 #include <QString>
 #include <QStringList>
 
@@ -48,39 +54,39 @@ class Option {
          optionArray(options);
       }
 
-      ~Option() { destroy(); }
-
-      Option(Option const& that) { copy(that); }
-
-      Option const& operator=(Option const& that);
+      typedef QPair<QString,QString> Replacement;
 
       // Accessors 
       QString const&     getName()        const { return m_name; }
       QString const&     getDescription() const { return m_description; }
       QStringList const& getOptions()     const { return m_options; }
+      QStringList const& getValues()      const { return m_values; }
+      QList<Replacement> const& getReplacements() const { 
+         return m_replacements; 
+      }
       Type getType()            const { return m_type; }
       int  getDefaultIndex()    const { return m_default; }
       Impl getImplementation()  const { return m_implementation; }
       QString getOptionString() const { return optionString(); }
       QString getDefaultValue() const;
          
-      int intMin() const;
-      int intMax() const;
-      int intDefault() const;
-      int intStep() const;
+      int intMin()     const { return m_intLimits[Limit_Min]; }
+      int intMax()     const { return m_intLimits[Limit_Max]; }
+      int intDefault() const { return m_intLimits[Limit_Default]; }
+      int intStep()    const { return m_intLimits[Limit_Step]; }
 
-      double doubleMin() const;
-      double doubleMax() const;
-      double doubleDefault() const;
-      double doubleStep() const;
+      double doubleMin()     const { return m_doubleLimits[Limit_Min]; }
+      double doubleMax()     const { return m_doubleLimits[Limit_Max]; }
+      double doubleDefault() const { return m_doubleLimits[Limit_Default]; }
+      double doubleStep()    const { return m_doubleLimits[Limit_Step]; }
 
 
    protected:
       // Mutators
       void setName(QString const& name) { m_name = name.toUpper(); }
-      void setType(Type const& type) { m_type = type; }
+      void setType(Type const& type) { m_type = type; parseLimits(); }
       void setDefault(int const& defaultValue) { m_default = defaultValue; }
-      void setOptions(QStringList const& options) { m_options = options; }
+      void setOptions(QStringList const& options);
       void setDescription(QString const& description) { m_description = description; }
       void setImplementation(Impl const& impl) { m_implementation = impl; }
       void setOptions(QString const& options) { optionArray(options); }
@@ -96,14 +102,19 @@ class Option {
       QString m_description;
       Impl m_implementation;
       QStringList m_options;
+
+      // These are parsed from m_options whenever the options or type are set
+      QStringList m_values;   // m_options with the replacements removed
+      QList<Replacement> m_replacements;
+      int m_intLimits[4];
+      double m_doubleLimits[4];
        
 
       // Private member functions
-      void copy(Option const&);
-      void destroy();
-
       void optionArray(QString const& options);
       QString optionString() const;
+      void parseValues();
+      void parseLimits();
 };
 
 } // end namespace Qui
@@ -21,39 +21,78 @@
  *     option is entered as 'a//b' it will appear in the interface as a, and be
  *     replaced with b in the input file.  This means the forward slash should
  *     not be used in the value string either.
+ *   - The options are read once into an in-memory catalog keyed on the upper
+ *     case option name, and lookups via get() are served from the catalog.
+ *     By default the catalog is built from OptionSchema.C, which is generated
+ *     from qchem_option.db at build time by GenerateOptionSchema.py, so the
+ *     sqlite file is never opened.  If useDatabaseFile() is called before the
+ *     first call to instance() the options table is read from the file
+ *     instead, and insert() and remove() write through to the database and
+ *     then update the corresponding catalog record.  This is only required
+ *     for the -dbedit mode.
+ *   - Lookups via get() and all() may be made from any thread, for example
+ *     while input files are parsed in parallel.  The first call to instance()
+ *     and all writes must be made from the GUI thread, which owns the
+ *     database connection.
+ *   - All writes use statements that are prepared once with bound values.
+ *     apply() can be used to write many records within a single transaction,
+ *     which is much faster than individual calls to insert() when importing
+ *     or bulk editing options.
  *   
  *  \author Andrew Gilbert
  *  \date August 2008
  */
 
 #include <vector>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringList>
+#include "Option.h"
 
-class QString;
-class QStringList;
+class QSqlQuery;
 
 namespace Qui {
 
-class Option;
-
 class OptionDatabase {
 
    public:
       static OptionDatabase& instance();
+      static void useDatabaseFile(bool const useFile);
 
       bool insert(Option const& opt, bool const promptOnOverwrite = true);
       bool remove(QString const& name, bool const prompt = true);
       bool get(QString const& name, Option& opt);
+      bool apply(std::vector<Option> const& inserts, 
+         QStringList const& removals = QStringList());
       QStringList all();
 
    private:
+      typedef QHash<QString, Option> Catalog;
+
       OptionDatabase();
       explicit OptionDatabase(OptionDatabase const&) { }
-      ~OptionDatabase() { }
+      ~OptionDatabase();
       static void destroy();
       void init();
-      bool execute(QString const&);
+      void loadCatalog();
+      void loadSchema();
+      void prepareStatements();
+      bool prepare(QSqlQuery&, QString const& sql);
+      bool execute(QSqlQuery&, bool const matchRecord = false);
+      bool write(Option const& opt, bool const exists);
+      bool erase(QString const& name);
+      Catalog::const_iterator find(QString const& name) const;
+
+      Catalog m_catalog;
+      mutable QReadWriteLock m_lock;
+      bool m_writable;
+      QSqlQuery* m_insertQuery;
+      QSqlQuery* m_updateQuery;
+      QSqlQuery* m_removeQuery;
 
       static bool s_okay;
+      static bool s_useDatabaseFile;
       static OptionDatabase* s_instance;   
       static std::vector<QString> s_dbFields;
 };
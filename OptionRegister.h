@@ -17,6 +17,7 @@
 
 #ifdef QT_CORE_LIB
 #include "QtNode.h"
+#include "Symbol.h"
 #else
 #include "Node.h"
 #endif
@@ -24,13 +25,17 @@
 
 namespace Qui {
 
+// With Qt the nodes are keyed on interned Symbols, so Register lookups
+// compare integer ids rather than strings.
 #ifdef QT_CORE_LIB
    typedef QtNode NodeT;
+   typedef Symbol OptionKey;
 #else
    typedef Node<String> NodeT;
+   typedef String OptionKey;
 #endif
 
-typedef Register<String, NodeT> OptionRegister;
+typedef Register<OptionKey, NodeT> OptionRegister;
 
 } // end namespace Qui
 
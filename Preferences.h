@@ -74,6 +74,12 @@ void    QChemRunScript(QString const&);
 int     NumberOfProcesses();
 void    NumberOfProcesses(int);
 
+int     ThreadsPerJob();
+void    ThreadsPerJob(int);
+
+QString QueueJournal();
+void    QueueJournal(QString const&);
+
 
 // These functions are generic and should only be used within the Preferences
 // module and not in the general code.
@@ -11,9 +11,11 @@
  */
 
 #include "ui_ProcessMonitor.h"
+#include "Telemetry.h"
 
 #include <QTime>
 #include <QTimer>
+#include <QDateTime>
 #include <QString>
 #include <QObject>
 #include <QProcess>
@@ -21,8 +23,8 @@
 #include <QStringList>
 #include <QMainWindow>
 #include <map>
+#include <list>
 #include <vector>
-#include <queue>
 
 #include <signal.h>
 
@@ -32,7 +34,7 @@ namespace Process {
 
 struct Status {
    enum ID { NotRunning = 0, Starting, Running, Queued, Crashed, Killed,
-             Error, Finished, Unknown };
+             Error, Finished, Cancelled, Unknown };
 };
 
 QString ToString(Status::ID const& state);
@@ -40,6 +42,18 @@ QString ToString(Status::ID const& state);
 bool KillProcess(int const pid, int const signal = SIGTERM);
 
 
+//! \struct Resources holds the number of cores and amount of memory (in MB)
+//! requested by a process, or available on the machine.  A memory of 0 means
+//! no limit.
+struct Resources {
+   Resources(int const cores = 1, int const memory = 0) 
+    : cores(cores), memory(memory) { }
+   static Resources machine();
+   int cores;
+   int memory;
+};
+
+
 //! \class Process is a base class for the other process types, Timed,
 //! Monitored etc.  It caches the program name and arguments for use in
 //! a Queue and also over-rides some of the QProcess functions to allow
@@ -53,7 +67,7 @@ class Process : public QProcess {
               QString const& program,
               QStringList const& arguments)
        : QProcess(parent),  m_program(program), m_arguments(arguments),
-         m_status(Status::Unknown), m_started(false) { }
+         m_status(Status::Unknown), m_started(false), m_waitTime(-1) { }
 
       virtual ~Process() { }
       virtual void start();
@@ -63,12 +77,25 @@ class Process : public QProcess {
       virtual void setArguments(QStringList const& arguments);
 
       Status::ID status() const;
+      QStringList const& argumentList() const { return m_arguments; }
+
+      //! These are used by the Queue to record how long the process waited
+      //! before it was started, to cancel it if it can no longer run and to
+      //! mark it as failed if it could not be started.
+      void queued() { m_queueTime.start(); }
+      void cancel() { m_status = Status::Cancelled; }
+      void failed() { m_status = Status::Error; }
+      int waitTime() const;
 
    protected:
       QString m_program;
       QStringList m_arguments;
       Status::ID m_status;
       bool m_started;
+
+   private:
+      QTime m_queueTime;
+      int m_waitTime;
 };
 
 
@@ -88,6 +115,10 @@ class Timed : public Process {
       QString formattedTime();
       QString formattedStartTime() { return m_formattedStartTime; }
 
+   protected:
+      void resume(QDateTime const& started, 
+         QDateTime const& finished = QDateTime());
+
    private Q_SLOTS:
       void anotherDay() { ++m_days; }
       void finish(int, QProcess::ExitStatus);
@@ -103,7 +134,9 @@ class Timed : public Process {
 
 
 //! \class Monitored is designed to operate with the Monitor and so has the
-//! necessary data members for all the fields in the table.
+//! necessary data members for all the fields in the table.  While the process
+//! is running the resources used by it and its children are sampled into its
+//! Telemetry.
 class Monitored : public Timed {
 
    Q_OBJECT
@@ -113,9 +146,10 @@ class Monitored : public Timed {
       Monitored(QObject* parent,
                 QString const& program,
                 QStringList const& arguments = QStringList());
-      virtual ~Monitored() { }
+      virtual ~Monitored();
 
       void kill();
+      Telemetry const& telemetry() const { return m_telemetry; }
 
       QString error()       const { return m_error; }
       QString programName() const { return m_program; }
@@ -133,6 +167,7 @@ class Monitored : public Timed {
       QString m_outputFile;
       QString m_inputFile;
       QString m_auxFile;
+      Telemetry m_telemetry;
 
    private Q_SLOTS:
       void processFinished(int, QProcess::ExitStatus);
@@ -151,6 +186,7 @@ class QChem : public Monitored {
    public:
       QChem(QObject* parent, QString const& input, QString const& output);
 
+      void kill();
       int  pid() const;
 
    private Q_SLOTS:
@@ -159,6 +195,10 @@ class QChem : public Monitored {
    private:
       void checkForErrors();
       void renameFchkFile();
+
+      //! The number of bytes at the end of the output file that are searched
+      //! for the fatal error banner.
+      static qint64 const s_errorScanSize = 1 << 20;
 };
 
 
@@ -187,6 +227,7 @@ class Monitor: public QMainWindow {
 
    private Q_SLOTS:
       void menuClose();
+      void menuExportTelemetry();
       void refresh();
       void on_addProcessButton_clicked(bool);
       void on_stopProcessButton_clicked(bool);
@@ -201,37 +242,92 @@ class Monitor: public QMainWindow {
       QTimer* m_timer;
       ProcessMap m_processList;
 
+      //! The first of the telemetry columns, CPU, Memory, Scratch and I/O
+      static int const s_telemetryColumn  = 7;
+      static int const s_sparklineWidth   = 60;
+      static int const s_sparklineHeight  = 14;
+
       void initializeMenus();
       void updateRow(int row, Monitored* process);
+      void updateTelemetry(int row, Monitored* process);
       void displayOutputFile(int row);
       ProcessMap::iterator findSelectedProcess();
 };
 
 
 
-//! \class Queue holds a list of processes to run sequentially.
+//! \class Queue holds a list of processes waiting to run.  Processes are
+//! considered in order of priority, and then of submission, and each is
+//! started as soon as the processes it depends on have finished and the cores
+//! and memory it requests fit in what is left of the machine.  Smaller
+//! processes may be packed in ahead of one that does not fit, but only
+//! s_maxBypass times so that large processes are not starved.  The number of
+//! processes running at once is also limited by
+//! Preferences::NumberOfProcesses().  If a dependency does not finish
+//! successfully, the processes that depend on it are cancelled.  Once
+//! restore() has been called the queue is kept in a Journal so that it
+//! survives a restart, unless the journal belongs to another session.
+class Journal;
+
 class Queue : public QObject {
 
    Q_OBJECT
 
    public:
-      Queue(QObject* parent, int maxProcesses = 1)
-       : QObject(parent), m_nProcesses(0), m_maxProcesses(maxProcesses) { }
-      ~Queue() { }
-      void submit(Process* process);
+      Queue(QObject* parent, Resources const& limits = Resources::machine())
+       : QObject(parent), m_limits(limits), m_inUse(0, 0), m_nSubmitted(0),
+         m_journal(0) { }
+      ~Queue();
+      void submit(Process* process, Resources const& resources = Resources(),
+         int const priority = 0, 
+         std::vector<Process*> const& dependencies = std::vector<Process*>());
+      std::vector<Monitored*> restore(QString const& journalFile);
 
    public Q_SLOTS:
       void remove(Process* process);
 
    private Q_SLOTS:
+      void processStarted();
       void processFinished(int, QProcess::ExitStatus);
+      void processError(QProcess::ProcessError);
+      void runQueue();
 
    private:
-      std::queue<Process*> m_processQueue;
-      int m_nProcesses;
-      int m_maxProcesses;
-
-      void runQueue();
+      struct Entry {
+         Process* process;
+         Resources resources;
+         int priority;
+         unsigned int bypassed;
+         //! The processes still to finish, and whether any of them has failed
+         std::vector<Process*> dependencies;
+         bool failed;
+      };
+
+      enum Readiness { Ready, Waiting, Failed };
+
+      //! Waiting processes, sorted by priority and then submission order
+      std::list<Entry> m_waiting;
+      std::map<Process*, Resources> m_running;
+
+      Resources m_limits;
+      Resources m_inUse;
+      unsigned int m_nSubmitted;
+
+      //! If set, every change to the queue is recorded in the journal, where
+      //! processes are identified by the ids in m_ids.
+      Journal* m_journal;
+      std::map<Process*, QString> m_ids;
+
+      static unsigned int const s_maxBypass = 8;
+
+      void enqueue(Process* process, Resources const& resources,
+         int const priority, std::vector<Process*> const& dependencies);
+      void journalFinished(Process* process, Status::ID const status,
+         QString const& error = QString());
+      Readiness readiness(Entry& entry);
+      void forget(Process* process, bool const failed);
+      bool fits(Resources const& resources) const;
+      void release(Process* process);
 };
 
 
@@ -0,0 +1,78 @@
+#ifndef QUI_PROCESSTREE_H
+#define QUI_PROCESSTREE_H
+
+/*!
+ *  \class ProcessTree
+ *
+ *  \brief Caches the parent/child relationships of the processes running on
+ *  the machine, as read from /proc.  This is used to find the qcprog.exe
+ *  process that sits below the wrapper scripts of a QChem job without
+ *  having to run ps.
+ *
+ *  \b Note:
+ *   - Only the subtree below the requested root is read when update() is
+ *     called.  If the kernel provides /proc/<pid>/task/<tid>/children these
+ *     are followed directly, otherwise the whole of /proc is scanned, but
+ *     only processes not already in the cache have their stat file read.
+ *   - usage() sums the resources used by a subtree, for the Sampler.
+ *   - This is only functional on Linux, elsewhere the tree is always empty.
+ *   - The tree is not thread safe, but separate trees can be used on separate
+ *     threads.
+ *
+ *  \date March 2009
+ */
+
+#include <QString>
+#include <map>
+#include <vector>
+
+
+namespace Qui {
+namespace Process {
+
+class ProcessTree {
+
+   public:
+      //! Resources used by a group of processes.  The times are in clock
+      //! ticks, the rest in bytes.
+      struct Usage {
+         Usage() : cpuTicks(0), rss(0), readBytes(0), writeBytes(0) { }
+         qint64 cpuTicks;
+         qint64 rss;
+         qint64 readBytes;
+         qint64 writeBytes;
+      };
+
+      ProcessTree();
+      static ProcessTree& instance();
+
+      void update(int const root);
+      std::vector<int> descendants(int const root) const;
+      int find(int const root, QString const& name);
+      bool usage(int const root, Usage& total) const;
+
+      static QString WorkingDirectory(int const pid);
+      static qint64 StartTime(int const pid);
+
+   private:
+      struct Node {
+         Node() : parent(0) { }
+         int parent;
+         QString name;
+         std::vector<int> children;
+      };
+
+      typedef std::map<int, Node> NodeMap;
+      NodeMap m_nodes;
+
+      bool m_haveChildrenFiles;
+
+      static bool ReadStat(int const pid, Node& node);
+      static bool ReadChildren(int const pid, std::vector<int>& children);
+      void scan();
+      void erase(int const root);
+};
+
+} } // end namespaces Qui::Process
+
+#endif
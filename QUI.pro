@@ -50,7 +50,8 @@ HEADERS += OptionDatabaseForm.h OptionEditors.h InputDialog.h Node.h \
 		   Actions.h Qui.h Job.h FileDisplay.h KeywordSection.h \ 
 		   RemSection.h Preferences.h MoleculeSection.h \
 		   GeometryConstraint.h OptSection.h ExternalChargesSection.h \
-           LJParametersSection.h FindDialog.h Process.h
+           LJParametersSection.h FindDialog.h Process.h Symbol.h \
+           Tokenizer.h Geometry.h XyzTrajectory.h Journal.h ProcessTree.h Telemetry.h
            
 SOURCES += main.C OptionDatabaseForm.C Option.C OptionDatabase.C \
            OptionEditors.C Conditions.C Actions.C \
@@ -59,7 +60,23 @@ SOURCES += main.C OptionDatabaseForm.C Option.C OptionDatabase.C \
            RemSection.C Preferences.C MoleculeSection.C InputDialog.C \
 		   GeometryConstraint.C  OptSection.C ExternalChargesSection.C \
            LJParametersSection.C FindDialog.C Process.C InputDialogMenu.C \
-           ProcessQChemKill.C getpids.C
+           ProcessQChemKill.C getpids.C Symbol.C Tokenizer.C \
+           Geometry.C XyzTrajectory.C Journal.C ProcessTree.C Telemetry.C
+
+# The option schema is generated from the option database so that the QUI does
+# not need to open the database file at run time.  Use qmake PYTHON=... to
+# choose the interpreter.
+isEmpty(PYTHON):PYTHON = python3
+option_schema.target   = OptionSchema.C
+option_schema.depends  = $$PWD/qchem_option.db $$PWD/GenerateOptionSchema.py
+option_schema.commands = $$PYTHON $$PWD/GenerateOptionSchema.py \
+                         $$PWD/qchem_option.db OptionSchema.h OptionSchema.C
+option_schema_h.target  = OptionSchema.h
+option_schema_h.depends = OptionSchema.C
+QMAKE_EXTRA_TARGETS   += option_schema option_schema_h
+PRE_TARGETDEPS        += OptionSchema.h OptionSchema.C
+GENERATED_SOURCES     += OptionSchema.C
+QMAKE_CLEAN           += OptionSchema.h OptionSchema.C
 
 FORMS += OptionDatabaseForm.ui OptionListEditor.ui OptionNumberEditor.ui \
          FileDisplay.ui QuiMainWindow.ui PreferencesBrowser.ui \
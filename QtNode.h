@@ -48,6 +48,8 @@ class QtNode : public QObject, public Node<QString> {
          valueChanged(m_name,getValue());
       }
 
+      QString description() const { return m_name; }
+
 
    private:
       QString m_name;
@@ -21,6 +21,7 @@ class QRadioButton;
 class QCheckBox;
 class QLineEdit;
 class QFile;
+class QByteArray;
 class QVariant;
 
 
@@ -31,6 +32,7 @@ namespace Avogadro {
 namespace Qui {
 
 class Job;
+class Geometry;
 class KeywordSection;
 
 void InitializeQChemLogic();
@@ -44,12 +46,14 @@ void SetControl(QDoubleSpinBox*, QString const&);
 
 // Parsing funtions
 void ReadInputFile(QFile& file, std::vector<Job*>*, QString* coordinates);
-QStringList ReadFileToList(QFile& file);
 QString ReadFile(QFile& file);
-QString ParseXyzFileContents(QString const& lines, bool bailOnError = false);
-QString ParseXyzCoordinates(QStringList const& lines, bool bailOnError = false);
+QString TrimLines(QString const& text);
+QByteArray TrimLines(char const* data, int const size);
+bool ParseXyzGeometry(QString const& contents, Geometry& geometry,
+   std::vector<int>* badLines = 0);
 
-std::vector<Job*> ParseQChemFileContents(QString const& lines);
+std::vector<Job*> ParseQChemFileContents(QString const& lines, 
+   QStringList* errors = 0);
 
 
 
@@ -58,7 +62,10 @@ std::vector<Job*> ParseQChemFileContents(QString const& lines);
 //! all possible sections are returned, so if there are multiple jobs then
 //! there exists abiguity over which sections belong to which job.  This can be
 //! resolved by spliting the string/file on @@@ before invoking this function.
-std::vector<KeywordSection*> ReadKeywordSections(QString input);
+//! Problems found in the input are appended to errors, if given, with line
+//! numbers counted from firstLine.
+std::vector<KeywordSection*> ReadKeywordSections(QString const& input, 
+   QStringList* errors = 0, int const firstLine = 1);
 
 
 #ifdef AVOGADRO
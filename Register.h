@@ -45,6 +45,10 @@ class Register {
          }
       }
 
+      //! Batches changes to the registered items, see NodeBase for details.
+      void beginTransaction() { T::beginTransaction(); }
+      void commitTransaction() { T::commitTransaction(); }
+
       bool exists(K key) {
          return s_items.find(key) != s_items.end();
       }
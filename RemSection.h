@@ -4,40 +4,108 @@
 /*!
  *  \class RemSection
  *
- *  \brief A KeywordSection class representing a $rem block
+ *  \brief A KeywordSection class representing a $rem block.  The option
+ *  values are stored in flat arrays indexed by the Symbol id of the option
+ *  name, along with flags indicating which options are set and which are to
+ *  be printed.  This avoids string comparisons on lookup.  The arrays are
+ *  implicitly shared, so a cloned RemSection only copies them when one of
+ *  the copies is modified.
  *   
  *  \author Andrew Gilbert
  *  \date January 2008
  */
 
 #include <map>
-#include <set>
+#include <vector>
+#include <utility>
 #include <QString>
+#include <QSharedData>
+#include <QSharedDataPointer>
 #include "KeywordSection.h" 
+#include "Symbol.h" 
 
 
 namespace Qui {
 
+//! The option state of a RemSection.  Values are indexed by Symbol id, along
+//! with flags indicating which options are set and which are to be printed.
+class RemData : public QSharedData {
+   public:
+      std::vector<QString> m_values;
+      std::vector<bool> m_isSet;
+      std::vector<bool> m_toPrint;
+};
+
+
+//! A read-only view of the options set in a RemSection.  The view shares the
+//! underlying data with the section, so it is cheap to create and copy, and
+//! it is not affected by subsequent changes to the section.
+class OptionView {
+   public:
+      class const_iterator {
+         public:
+            const_iterator(RemData const* data = 0, unsigned int id = 0) 
+             : m_data(data), m_id(id) { skip(); }
+
+            QString const& name() const { return Symbol::name(m_id); }
+            QString const& value() const { return m_data->m_values[m_id]; }
+
+            const_iterator& operator++() { ++m_id; skip(); return *this; }
+            bool operator==(const_iterator const& that) const { 
+               return m_id == that.m_id;
+            }
+            bool operator!=(const_iterator const& that) const { 
+               return m_id != that.m_id;
+            }
+
+         private:
+            RemData const* m_data;
+            unsigned int m_id;
+
+            void skip() {
+               if (!m_data) return;
+               while (m_id < m_data->m_isSet.size() && !m_data->m_isSet[m_id]) {
+                  ++m_id;
+               }
+            }
+      };
+
+      OptionView() { }
+      explicit OptionView(QSharedDataPointer<RemData> const& data) 
+       : m_data(data) { }
+
+      const_iterator begin() const { 
+         return const_iterator(m_data.constData(), 0); 
+      }
+      const_iterator end() const { 
+         RemData const* data(m_data.constData());
+         return const_iterator(0, data ? data->m_isSet.size() : 0);
+      }
+
+   private:
+      QSharedDataPointer<RemData> m_data;
+};
+
+
+
 class RemSection : public KeywordSection {
    public:
-      RemSection() : KeywordSection("rem") { init(); }
+      RemSection() : KeywordSection("rem"), m_data(new RemData) { init(); }
 
       void read(QString const& data);
       RemSection* clone() const;
 
-      void printOption(QString const& option, bool print);
-      bool printOption(QString const& option);
+      bool printOption(Symbol const& option, bool print);
+      bool printOption(Symbol const& option) const;
 
-      QString getOption(QString const& name);
+      QString getOption(Symbol const& name) const;
 
       static void printAdHoc();
 
-      std::map<QString,QString> getOptions();
+      OptionView getOptions() const { return OptionView(m_data); }
       
-      static void addAdHoc(QString const& rem, QString const& v1, QString const& v2);
-      void setOption(QString const& name, QString const& value) { 
-           m_options[name] = value; 
-      }
+      static void addAdHoc(Symbol const& rem, QString const& v1, QString const& v2);
+      bool setOption(Symbol const& name, QString const& value);
 
 
    protected:
@@ -45,23 +113,23 @@ class RemSection : public KeywordSection {
 
 
    private:
+      typedef std::map<std::pair<Symbol,QString>, QString> AdHocMap;
+
       // ---------- Data ---------
-      static std::map<QString,QString> m_adHoc;
+      static AdHocMap m_adHoc;
+      static AdHocMap createAdHoc();
+      static void applyAdHoc(Symbol const& rem, QString& value);
 
-      std::map<QString,QString> m_options;
-      std::set<QString> m_toPrint;
+      //! Shared with clones until one of them is modified
+      QSharedDataPointer<RemData> m_data;
 
       // ---------- Member Functions ---------
       void init();
       bool fixOptionForQui(QString& name, QString& value);
-      bool fixOptionForQChem(QString& name, QString& value);
-
-      bool printOption(QString const& option) const {
-         return m_toPrint.count(option) > 0;
-      }
+      bool fixOptionForQChem(QString& name, QString& value) const;
 
-      void setOptions(std::map<QString,QString> const& options);
-      void setPrint(std::set<QString> const& toPrint);
+      QString& option(Symbol const& name);
+      void resize(unsigned int const n);
 };
 
 } // end namespace Qui
@@ -0,0 +1,62 @@
+#ifndef QUI_SYMBOL_H
+#define QUI_SYMBOL_H
+
+/*!
+ *  \class Symbol
+ *
+ *  \brief An interned option name.  Each distinct (upper case) name is
+ *  assigned a small integer id the first time it is seen, and the Symbol
+ *  simply holds this id.  This means Symbols are cheap to copy and compare,
+ *  and can be used to index flat arrays rather than string keyed maps.
+ *
+ *  \b Note:
+ *   - Names are converted to upper case when they are interned, so "basis"
+ *     and "BASIS" are the same Symbol.
+ *   - The id 0 is always the empty name, which is what a default constructed
+ *     Symbol refers to.
+ *   - Symbols are ordered by id, not name.  sorted() gives the ids in name
+ *     order for when alphabetical output is required.
+ *   - Symbols can be created and looked up from any thread, e.g. when input
+ *     files are parsed in parallel.  The names are held in a deque so that
+ *     references returned by name() are not invalidated by later additions.
+ *
+ *  \date March 2009
+ */
+
+#include <deque>
+#include <vector>
+#include <QString>
+
+
+namespace Qui {
+
+class Symbol {
+
+   public:
+      Symbol() : m_id(0) { }
+      Symbol(QString const& name) : m_id(intern(name)) { }
+      Symbol(char const* name) : m_id(intern(QString(name))) { }
+
+      unsigned int id() const { return m_id; }
+      QString const& name() const { return name(m_id); }
+      operator QString() const { return name(); }
+
+      bool operator==(Symbol const& that) const { return m_id == that.m_id; }
+      bool operator!=(Symbol const& that) const { return m_id != that.m_id; }
+      bool operator<(Symbol const& that) const { return m_id < that.m_id; }
+
+      static unsigned int count();
+      static QString const& name(unsigned int const id);
+      static std::vector<unsigned int> sorted();
+
+
+   private:
+      unsigned int m_id;
+
+      static unsigned int intern(QString const& name);
+      static std::deque<QString>& names();
+};
+
+} // end namespace Qui
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef QUI_TELEMETRY_H
+#define QUI_TELEMETRY_H
+
+/*!
+ *  \file Telemetry.h
+ *
+ *  \brief Classes used to record the resources used by running jobs.
+ *
+ *  \date March 2009
+ */
+
+#include "ProcessTree.h"
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <vector>
+
+class QTextStream;
+
+
+namespace Qui {
+namespace Process {
+
+
+//! \struct Sample holds the resources used by a job at one point in time.
+//! The time is in milliseconds since the epoch, the CPU usage is a percentage
+//! of one core and the remaining values are in bytes or bytes per second.
+struct Sample {
+   Sample() : time(0), cpu(0.0), rss(0), scratch(0), readRate(0.0), 
+      writeRate(0.0) { }
+   qint64 time;
+   double cpu;
+   qint64 rss;
+   qint64 scratch;
+   double readRate;
+   double writeRate;
+};
+
+
+
+//! \class Telemetry is a fixed size ring buffer of Samples.  The samples are
+//! written by the Sampler thread and read by the Monitor, so access is
+//! serialized.  Once the buffer is full the oldest samples are overwritten.
+class Telemetry {
+
+   public:
+      Telemetry() : m_samples(s_capacity), m_next(0), m_count(0) { }
+
+      void append(Sample const& sample);
+      std::vector<Sample> samples() const;
+      bool latest(Sample& sample) const;
+      void writeCsv(QTextStream& stream) const;
+
+      //! Enough for an hour at the default sampling interval
+      static unsigned int const s_capacity = 1800;
+
+   private:
+      mutable QMutex m_mutex;
+      std::vector<Sample> m_samples;
+      unsigned int m_next;
+      unsigned int m_count;
+};
+
+
+
+//! \class Sampler is a single background thread that periodically measures
+//! the process trees of the watched jobs and appends the results to their
+//! Telemetry.  The /proc reads, and the scratch directory walk in particular,
+//! are done without holding the lock so the GUI is never held up.  The thread
+//! only runs while there is something to watch, and is stopped for good when
+//! the application quits.
+class Sampler : public QThread {
+
+   Q_OBJECT
+
+   public:
+      static Sampler& instance();
+      ~Sampler();
+
+      void watch(int const pid, Telemetry* telemetry);
+      void unwatch(Telemetry* telemetry);
+
+   public Q_SLOTS:
+      void stop();
+
+   protected:
+      void run();
+
+   private:
+      struct Target {
+         Target() : pid(0), telemetry(0), lastTime(0) { }
+         int pid;
+         Telemetry* telemetry;
+         ProcessTree::Usage last;
+         qint64 lastTime;
+         QString scratch;
+      };
+
+      Sampler();
+      bool sample(Target& target, Sample& sample);
+
+      QMutex m_mutex;
+      QWaitCondition m_wake;
+      bool m_stop;
+      //! Set while run() is sampling, cleared once it has nothing to watch
+      bool m_running;
+      std::vector<Target> m_targets;
+      ProcessTree m_tree;
+
+      //! Sampling interval in milliseconds
+      static unsigned long const s_interval = 2000;
+};
+
+
+} } // end namespaces Qui::Process
+
+#endif
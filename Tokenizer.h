@@ -0,0 +1,44 @@
+#ifndef QUI_TOKENIZER_H
+#define QUI_TOKENIZER_H
+
+/*!
+ *  \file Tokenizer.h
+ *
+ *  \brief Simple scanners used by the section readers to break text into
+ *  lines and whitespace separated tokens.  These are hand written rather than
+ *  using QRegExp("\\n") and QRegExp("\\s+"), which were being constructed, and
+ *  hence compiled, once per line when reading large molecules and charge
+ *  lists.  ScanDouble() is used in place of QString::toDouble() when
+ *  reading coordinates, which avoids creating a QString for every number.
+ *
+ *  \date March 2009
+ */
+
+#include <QString>
+#include <QStringList>
+
+
+namespace Qui {
+
+//! Splits the text on newline characters.  This is equivalent to
+//! text.split(QRegExp("\\n")), with empty lines removed if skipEmpty is set.
+QStringList SplitLines(QString const& text, bool const skipEmpty = false);
+
+//! Splits the text into tokens separated by whitespace.  This is equivalent to
+//! text.split(QRegExp("\\s+"), QString::SkipEmptyParts).
+QStringList SplitWords(QString const& text);
+
+//! Reads a number of the form accepted by QString::toDouble() from the text
+//! starting at pos, which is left pointing just past the number.  Returns
+//! false, leaving pos unchanged, if the text does not start with a number.
+//! Note that this does not check what follows the number.
+bool ScanDouble(QChar const*& pos, QChar const* const end, double& value);
+
+//! Returns the number of newline characters in the text.
+inline int CountNewlines(QString const& text) { 
+   return text.count(QChar('\n')); 
+}
+
+} // end namespace Qui
+
+#endif
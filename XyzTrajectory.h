@@ -0,0 +1,73 @@
+#ifndef QUI_XYZTRAJECTORY_H
+#define QUI_XYZTRAJECTORY_H
+
+/*!
+ *  \class XyzTrajectory
+ *
+ *  \brief Provides access to the frames of a multi-frame xyz file, such as an
+ *  MD trajectory.  The file is memory mapped and scanned once when it is
+ *  opened to find where each frame starts, but the frames themselves are only
+ *  decoded when they are requested.  This means trajectories with thousands
+ *  of frames can be used without reading the whole file into memory.
+ *
+ *  \b Note:
+ *   - Each frame is a standard xyz block: the number of atoms, a comment line
+ *     and then one line per atom.  Blank lines between frames are ignored.
+ *   - If a problem is found while indexing, the frames before it can still be
+ *     used and error() describes the problem.
+ *
+ *  \date March 2009
+ */
+
+#include <vector>
+#include <QFile>
+#include <QString>
+
+
+namespace Qui {
+
+class Geometry;
+
+class XyzTrajectory {
+
+   public:
+      XyzTrajectory() : m_data(0), m_size(0) { }
+      ~XyzTrajectory() { close(); }
+
+      bool open(QString const& fileName);
+      void close();
+
+      int nFrames() const { return m_frames.size(); }
+      QString comment(int const frame) const;
+      bool frame(int const frame, Geometry& geometry, 
+         std::vector<int>* badLines = 0) const;
+
+      QString const& error() const { return m_error; }
+
+
+   private:
+      //! Offsets into the file of the comment line, the first atom and the
+      //! end of the frame, along with the line number of the first atom.
+      struct Frame {
+         qint64 comment;
+         qint64 atoms;
+         qint64 end;
+         int line;
+      };
+
+      QFile m_file;
+      uchar* m_data;
+      qint64 m_size;
+      std::vector<Frame> m_frames;
+      QString m_error;
+
+      void index();
+      qint64 nextLine(qint64 const pos) const;
+
+      XyzTrajectory(XyzTrajectory const& that);
+      XyzTrajectory const& operator=(XyzTrajectory const& that);
+};
+
+
+} // end namespace Qui
+#endif
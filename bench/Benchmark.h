@@ -0,0 +1,63 @@
+#ifndef QUI_BENCHMARK_H
+#define QUI_BENCHMARK_H
+
+/*!
+ *  \file Benchmark.h
+ *
+ *  \brief Timing and reporting functions shared by the benchmarks.
+ *
+ *  \date March 2009
+ */
+
+#include <QString>
+#include <cstdio>
+#include <sys/time.h>
+
+
+namespace Qui {
+namespace Benchmark {
+
+
+//! Wall clock time in milliseconds.
+inline double Now() {
+   struct timeval now;
+   gettimeofday(&now, 0);
+   return now.tv_sec * 1000.0 + now.tv_usec / 1000.0;
+}
+
+
+//! Runs function repeats times and returns the shortest time in milliseconds,
+//! which is the least affected by anything else running on the machine.
+template <class Function>
+double Best(Function function, int const repeats = 3) {
+   double best(0.0);
+   for (int i = 0; i < repeats; ++i) {
+       double start(Now());
+       function();
+       double time(Now() - start);
+       if (i == 0 || time < best) best = time;
+   }
+   return best;
+}
+
+
+//! Prints a line comparing the time taken by the original and current code.
+inline void Report(QString const& label, double const baseline, 
+   double const current) {
+   printf("%-44s baseline %10.1f ms   current %10.1f ms   %7.1fx\n",
+      label.toLocal8Bit().constData(), baseline, current, 
+      current > 0.0 ? baseline / current : 0.0);
+   fflush(stdout);
+}
+
+
+//! Prints a line with a single time, for runs with no baseline equivalent.
+inline void Report(QString const& label, double const time) {
+   printf("%-44s %10.1f ms\n", label.toLocal8Bit().constData(), time);
+   fflush(stdout);
+}
+
+
+} } // end namespaces Qui::Benchmark
+
+#endif